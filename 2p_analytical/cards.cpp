@@ -1,4 +1,5 @@
 #include "cards.hpp"
+#include <bit>
 #include <cstdint>
 #include <iostream>
 
@@ -193,22 +194,15 @@ uint8_t get_canonical_hand(uint64_t hand) {
   // have to assume that there are exactly 2 cards in the hand
   // idk if assertion ruins performance
 
-  uint8_t ret = 0;
-  uint8_t found = 0;
-
-  for (int i = 0; i < 4; i++) {
-    uint8_t suit_acc = 0;
-    uint8_t suit_count = 0;
-    for (int j = 12; j >= 0; j--) {
-      uint16_t bit = (hand >> (12 - j)) & 1;
-      suit_acc += j * bit * (1 + suit_count * 12);
-      suit_count += bit;
-    }
-    ret += suit_acc + (found > 0) * (suit_count > 0) * get_max(ret, suit_acc) * 12;
-    found += suit_count;
-    hand >>= 16;
-  }
-
-  return ret;
+  int bit1 = countr_zero(hand);
+  int bit2 = 63 - countl_zero(hand);
+  // row/column 0 is the Ace
+  uint32_t rank1 = 12 - bit1 % 16;
+  uint32_t rank2 = 12 - bit2 % 16;
+  uint32_t high = get_min(rank1, rank2);
+  uint32_t low = get_max(rank1, rank2);
+  uint32_t suited = (bit1 / 16) == (bit2 / 16);
+
+  // suited above the diagonal, off suit below it
+  return suited * (high * 13 + low) + (1 - suited) * (low * 13 + high);
 }
-  
\ No newline at end of file
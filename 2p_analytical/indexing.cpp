@@ -0,0 +1,376 @@
+#include "indexing.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// BINOMIAL[n][k] = C(n, k), enough for up to 7 cards out of 52
+constexpr array<array<uint64_t, 8>, 53> make_binomial_table() {
+  array<array<uint64_t, 8>, 53> table{};
+  for (int n = 0; n <= 52; n++) {
+    table[n][0] = 1;
+    for (int k = 1; k < 8; k++) {
+      table[n][k] = n ? table[n - 1][k - 1] + table[n - 1][k] : 0;
+    }
+  }
+  return table;
+}
+constexpr auto BINOMIAL = make_binomial_table();
+
+// BINOMIAL_BY_K[k][n] = C(n, k), each row is nondecreasing in n so unranking can binary search it
+constexpr array<array<uint64_t, 53>, 8> make_binomial_by_k_table() {
+  array<array<uint64_t, 53>, 8> table{};
+  for (int n = 0; n <= 52; n++) {
+    for (int k = 0; k < 8; k++) {
+      table[k][n] = BINOMIAL[n][k];
+    }
+  }
+  return table;
+}
+constexpr auto BINOMIAL_BY_K = make_binomial_by_k_table();
+
+// largest n < limit with C(n, k) <= idx, for k >= 1 so that n = 0 always qualifies
+int get_largest_choose(uint64_t idx, int k, int limit) {
+  const auto &row = BINOMIAL_BY_K[k];
+  return upper_bound(row.begin(), row.begin() + limit, idx) - row.begin() - 1;
+}
+
+// HOLE_CARDS[idx] = {c1, c2} with c1 < c2, so unindexing a combo is a lookup
+constexpr array<array<uint8_t, 2>, 1326> make_hole_table() {
+  array<array<uint8_t, 2>, 1326> table{};
+  for (int c2 = 1; c2 < 52; c2++) {
+    for (int c1 = 0; c1 < c2; c1++) {
+      table[c2 * (c2 - 1) / 2 + c1] = {(uint8_t) c1, (uint8_t) c2};
+    }
+  }
+  return table;
+}
+constexpr auto HOLE_CARDS = make_hole_table();
+
+int get_card_from_bit(int bit) {
+  return (bit % 16) * 4 + bit / 16;
+}
+
+int get_bit_from_card(int card) {
+  return card / 4 + (card % 4) * 16;
+}
+
+// rearrange the suit-major hand into a 52-bit mask where bit i is card i
+uint64_t get_deck_mask(uint64_t hand) {
+  uint64_t deck = 0;
+#ifdef __BMI2__
+  for (int suit = 0; suit < 4; suit++) {
+    deck |= _pdep_u64((hand >> (suit * 16)) & 0x1FFFU, 0x1111111111111ULL << suit);
+  }
+#else
+  for (; hand; hand &= hand - 1) {
+    deck |= ((uint64_t) 1) << get_card_from_bit(countr_zero(hand));
+  }
+#endif
+  return deck;
+}
+
+// keep only the n-th (from 0) lowest set bit of mask
+uint32_t get_nth_bit(uint32_t mask, int n) {
+#ifdef __BMI2__
+  return _pdep_u32(1U << n, mask);
+#else
+  for (int i = 0; i < n; i++) {
+    mask &= mask - 1;
+  }
+  return mask & -mask;
+#endif
+}
+
+uint32_t get_hole_index_from_int(int c1, int c2) {
+  int lo = min(c1, c2);
+  int hi = max(c1, c2);
+  return hi * (hi - 1) / 2 + lo;
+}
+
+// have to assume that there are exactly 2 cards in the hand
+uint32_t get_hole_index(uint64_t hand) {
+  int c1 = get_card_from_bit(countr_zero(hand));
+  int c2 = get_card_from_bit(63 - countl_zero(hand));
+  return get_hole_index_from_int(c1, c2);
+}
+
+void get_hole_cards(uint32_t idx, int &c1, int &c2) {
+  c1 = HOLE_CARDS[idx][0];
+  c2 = HOLE_CARDS[idx][1];
+}
+
+uint64_t get_hole_hand(uint32_t idx) {
+  return (((uint64_t) 1) << get_bit_from_card(HOLE_CARDS[idx][0])) |
+         (((uint64_t) 1) << get_bit_from_card(HOLE_CARDS[idx][1]));
+}
+
+// colex: the i-th smallest card c (from 1) adds C(c, i)
+uint32_t get_board_index(uint64_t board) {
+  uint64_t deck = get_deck_mask(board);
+  uint32_t idx = 0;
+  for (int i = 1; deck; i++) {
+    idx += BINOMIAL[countr_zero(deck)][i];
+    deck &= deck - 1;
+  }
+  return idx;
+}
+
+uint64_t get_board_hand(uint32_t idx, int num_cards) {
+  uint64_t board = 0;
+  int card = 52;
+  // peel off the largest card first: the largest c with C(c, i) <= idx
+  for (int i = num_cards; i > 0; i--) {
+    card = get_largest_choose(idx, i, card);
+    idx -= BINOMIAL[card][i];
+    board |= ((uint64_t) 1) << get_bit_from_card(card);
+  }
+  return board;
+}
+
+// C(n, k) for small k but n possibly past the table
+uint64_t get_choose(uint64_t n, int k) {
+  uint64_t result = 1;
+  for (int i = 1; i <= k; i++) {
+    result = result * (n + 1 - i) / i;
+  }
+  return (n >= (uint64_t) k) * result;
+}
+
+// suit-isomorphic indexing, after Waugh's hand indexer:
+// every suit is described by how many of its cards came on each round (its key),
+// suits with the same key are interchangeable, so each run of equal keys is
+// indexed as a multiset of per-suit indices, and each sorted tuple of 4 keys
+// (a configuration) gets its own block of indices
+
+// 3 bits per round for the number of cards of one suit dealt that round
+int get_key_count(uint32_t key, int round) {
+  return (key >> (round * 3)) & 7;
+}
+
+// colex index of ranks among the ranks not in used
+uint64_t get_rank_set_index(uint32_t ranks, uint32_t used) {
+  uint64_t idx = 0;
+  for (int i = 1; ranks; i++) {
+    int rank = countr_zero(ranks);
+    idx += BINOMIAL[rank - popcount(used & ((1U << rank) - 1))][i];
+    ranks &= ranks - 1;
+  }
+  return idx;
+}
+
+uint32_t get_rank_set(uint64_t idx, int num_ranks, uint32_t used) {
+  uint32_t ranks = 0;
+  int pos = 13 - popcount(used);
+  for (int i = num_ranks; i > 0; i--) {
+    pos = get_largest_choose(idx, i, pos);
+    idx -= BINOMIAL[pos][i];
+    ranks |= get_nth_bit(~used & 0x1FFFU, pos);
+  }
+  return ranks;
+}
+
+// number of ways one suit can hold its key, over all rounds
+uint64_t get_suit_size(uint32_t key, int num_rounds) {
+  uint64_t size = 1;
+  int used = 0;
+  for (int r = 0; r < num_rounds; r++) {
+    size *= BINOMIAL[13 - used][get_key_count(key, r)];
+    used += get_key_count(key, r);
+  }
+  return size;
+}
+
+// the rounds form a mixed radix number, first round least significant
+uint64_t get_suit_index(const uint32_t ranks[], int num_rounds) {
+  uint64_t idx = 0;
+  uint64_t mult = 1;
+  uint32_t used = 0;
+  for (int r = 0; r < num_rounds; r++) {
+    idx += mult * get_rank_set_index(ranks[r], used);
+    mult *= BINOMIAL[13 - popcount(used)][popcount(ranks[r])];
+    used |= ranks[r];
+  }
+  return idx;
+}
+
+// configurations sorted by code, where the code packs the 4 keys in decreasing order
+struct iso_table {
+  vector<uint64_t> codes;
+  vector<uint64_t> offsets;
+  uint64_t size;
+};
+
+uint32_t get_code_key(uint64_t code, int position) {
+  return (code >> ((3 - position) * 12)) & 0xFFFU;
+}
+
+// size of a configuration: a multiset of g suit indices per run of g equal keys
+uint64_t get_config_size(uint64_t code, int num_rounds) {
+  uint64_t size = 1;
+  for (int start = 0, end = 0; start < 4; start = end) {
+    while (end < 4 && get_code_key(code, end) == get_code_key(code, start)) end++;
+    int group = end - start;
+    size *= get_choose(get_suit_size(get_code_key(code, start), num_rounds) + group - 1, group);
+  }
+  return size;
+}
+
+iso_table build_iso_table(int num_rounds) {
+  // every key a single suit can have on its own
+  vector<uint32_t> keys = {0};
+  for (int r = 0; r < num_rounds; r++) {
+    vector<uint32_t> next;
+    for (uint32_t key : keys) {
+      for (int count = 0; count <= CARDS_PER_ROUND[r]; count++) {
+        next.push_back(key | (count << (r * 3)));
+      }
+    }
+    keys = next;
+  }
+
+  iso_table table;
+  for (uint32_t k0 : keys) for (uint32_t k1 : keys) for (uint32_t k2 : keys) for (uint32_t k3 : keys) {
+    // keep each configuration once, with its keys in decreasing order
+    if (k0 < k1 || k1 < k2 || k2 < k3) continue;
+    bool valid = true;
+    for (int r = 0; r < num_rounds; r++) {
+      valid &= get_key_count(k0, r) + get_key_count(k1, r) + get_key_count(k2, r) +
+               get_key_count(k3, r) == CARDS_PER_ROUND[r];
+    }
+    if (!valid) continue;
+    table.codes.push_back(((uint64_t) k0 << 36) | ((uint64_t) k1 << 24) | ((uint64_t) k2 << 12) | k3);
+  }
+  sort(table.codes.begin(), table.codes.end());
+
+  table.size = 0;
+  for (uint64_t code : table.codes) {
+    table.offsets.push_back(table.size);
+    table.size += get_config_size(code, num_rounds);
+  }
+  return table;
+}
+
+const iso_table &get_iso_table(int street) {
+  static const iso_table tables[4] = {
+    build_iso_table(1), build_iso_table(2), build_iso_table(3), build_iso_table(4)
+  };
+  return tables[street];
+}
+
+uint64_t get_isomorphic_size(int street) {
+  return get_iso_table(street).size;
+}
+
+uint64_t get_isomorphic_index(const uint64_t rounds[], int street) {
+  int num_rounds = street + 1;
+  uint64_t all = 0;
+  for (int r = 0; r < num_rounds; r++) {
+    // only the 13 rank bits of each suit, no card twice
+    if (popcount(rounds[r]) != CARDS_PER_ROUND[r] || (rounds[r] & ~0x1FFF1FFF1FFF1FFFULL) || (rounds[r] & all)) {
+      return INVALID_INDEX;
+    }
+    all |= rounds[r];
+  }
+
+  uint32_t keys[4];
+  uint64_t suit_idx[4];
+  int order[4] = {0, 1, 2, 3};
+  for (int suit = 0; suit < 4; suit++) {
+    uint32_t ranks[4];
+    keys[suit] = 0;
+    for (int r = 0; r < num_rounds; r++) {
+      ranks[r] = (rounds[r] >> (suit * 16)) & 0x1FFFU;
+      keys[suit] |= popcount(ranks[r]) << (r * 3);
+    }
+    suit_idx[suit] = get_suit_index(ranks, num_rounds);
+  }
+  // suits in decreasing (key, suit index), so equal keys are adjacent and sorted
+  sort(order, order + 4, [&](int a, int b) {
+    return keys[a] != keys[b] ? keys[a] > keys[b] : suit_idx[a] > suit_idx[b];
+  });
+
+  uint64_t code = 0;
+  for (int i = 0; i < 4; i++) {
+    code = (code << 12) | keys[order[i]];
+  }
+  const iso_table &table = get_iso_table(street);
+  size_t config = lower_bound(table.codes.begin(), table.codes.end(), code) - table.codes.begin();
+  // can't happen once the rounds are checked, but never read past the table
+  if (config == table.codes.size() || table.codes[config] != code) {
+    return INVALID_INDEX;
+  }
+
+  uint64_t idx = 0;
+  uint64_t mult = 1;
+  for (int start = 0, end = 0; start < 4; start = end) {
+    while (end < 4 && keys[order[end]] == keys[order[start]]) end++;
+    int group = end - start;
+    // colex over multisets: shift the i-th largest by its distance to the end to make it a set
+    uint64_t group_idx = 0;
+    for (int i = 0; i < group; i++) {
+      group_idx += get_choose(suit_idx[order[start + i]] + group - 1 - i, group - i);
+    }
+    idx += mult * group_idx;
+    mult *= get_choose(get_suit_size(keys[order[start]], num_rounds) + group - 1, group);
+  }
+  return table.offsets[config] + idx;
+}
+
+// the canonical representative puts the configuration's keys on suits 0, 1, 2, 3 in order
+void get_isomorphic_hand(uint64_t idx, int street, uint64_t rounds[]) {
+  int num_rounds = street + 1;
+  const iso_table &table = get_iso_table(street);
+  size_t config = upper_bound(table.offsets.begin(), table.offsets.end(), idx) - table.offsets.begin() - 1;
+  uint64_t code = table.codes[config];
+  idx -= table.offsets[config];
+
+  for (int r = 0; r < num_rounds; r++) {
+    rounds[r] = 0;
+  }
+  for (int start = 0, end = 0; start < 4; start = end) {
+    while (end < 4 && get_code_key(code, end) == get_code_key(code, start)) end++;
+    int group = end - start;
+    uint32_t key = get_code_key(code, start);
+    uint64_t suit_size = get_suit_size(key, num_rounds);
+    uint64_t group_size = get_choose(suit_size + group - 1, group);
+    uint64_t group_idx = idx % group_size;
+    idx /= group_size;
+
+    uint64_t shifted = suit_size + group - 1;
+    for (int i = 0; i < group; i++) {
+      int k = group - i;
+      // largest shifted value with C(shifted, k) <= group_idx, C(0, k) = 0 always qualifies
+      if (k == 1) {
+        shifted = group_idx;
+      } else {
+        uint64_t lo = 0;
+        for (uint64_t hi = shifted; hi - lo > 1;) {
+          uint64_t mid = lo + (hi - lo) / 2;
+          if (get_choose(mid, k) <= group_idx) lo = mid;
+          else hi = mid;
+        }
+        shifted = lo;
+      }
+      group_idx -= get_choose(shifted, k);
+      uint64_t suit_idx = shifted - (group - 1 - i);
+
+      uint32_t used = 0;
+      for (int r = 0; r < num_rounds; r++) {
+        int count = get_key_count(key, r);
+        uint64_t base = BINOMIAL[13 - popcount(used)][count];
+        uint32_t ranks = get_rank_set(suit_idx % base, count, used);
+        suit_idx /= base;
+        used |= ranks;
+        rounds[r] |= ((uint64_t) ranks) << ((start + i) * 16);
+      }
+    }
+  }
+}
@@ -0,0 +1,40 @@
+#ifndef INDEXING_HPP
+#define INDEXING_HPP
+
+#include <cstdint>
+
+// perfect indices over the 64-bit hand encoding (every 16 bits are the ranks of one suit)
+// cards as integers follow int_to_hand in main.cpp: rank = card / 4, suit = card % 4
+// indexing is O(cards), unindexing binary searches for each card so it's O(cards * log 52)
+
+// streets for the suit-isomorphic indexer, each adds one round of cards:
+// hole (2), flop (3), turn (1), river (1)
+const int PREFLOP = 0;
+const int FLOP = 1;
+const int TURN = 2;
+const int RIVER = 3;
+const int CARDS_PER_ROUND[4] = {2, 3, 1, 1};
+
+// returned by get_isomorphic_index when the rounds don't hold CARDS_PER_ROUND distinct cards each
+const std::uint64_t INVALID_INDEX = UINT64_MAX;
+
+int get_card_from_bit(int bit);
+int get_bit_from_card(int card);
+
+// 2-card combos in colex order, 0 -> 1325
+std::uint32_t get_hole_index(std::uint64_t hand);
+std::uint32_t get_hole_index_from_int(int c1, int c2);
+std::uint64_t get_hole_hand(std::uint32_t idx);
+void get_hole_cards(std::uint32_t idx, int &c1, int &c2);
+
+// k-card boards in colex order, 0 -> C(52, k) - 1
+std::uint32_t get_board_index(std::uint64_t board);
+std::uint64_t get_board_hand(std::uint32_t idx, int num_cards);
+
+// (hole, board) classes up to suit permutation, 0 -> get_isomorphic_size(street) - 1
+// rounds[r] holds the cards dealt on round r, for every round up to and including the street
+std::uint64_t get_isomorphic_size(int street);
+std::uint64_t get_isomorphic_index(const std::uint64_t rounds[], int street);
+void get_isomorphic_hand(std::uint64_t idx, int street, std::uint64_t rounds[]);
+
+#endif // INDEXING_HPP
@@ -0,0 +1,164 @@
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <bit>
+#include <algorithm>
+
+#include "indexing.hpp"
+
+using namespace std;
+
+// exhaustive/randomized checks of the indexers, prints every failure and exits nonzero
+const uint64_t BOARD_SIZES[6] = {1, 52, 1326, 22100, 270725, 2598960};
+const uint64_t ISOMORPHIC_SIZES[4] = {169, 1286792, 55190538, 2428287420ULL};
+const int RANDOM_HANDS = 1000000;
+
+int errors = 0;
+
+void check(bool ok, string message) {
+    if (!ok && errors++ < 10) {
+        cout << "[!] Error: " << message << endl;
+    }
+}
+
+uint64_t permute_suits(uint64_t hand, const int *suits) {
+    uint64_t permuted = 0;
+    for (int suit = 0; suit < 4; suit++) {
+        permuted |= ((hand >> (suit * 16)) & 0x1FFFU) << (suits[suit] * 16);
+    }
+    return permuted;
+}
+
+void check_hole() {
+    cout << "Checking hole cards..." << endl;
+    for (uint32_t idx = 0; idx < 1326; idx++) {
+        int c1, c2;
+        get_hole_cards(idx, c1, c2);
+        uint64_t hand = get_hole_hand(idx);
+        check(c1 < c2 && c2 < 52 && get_hole_index_from_int(c1, c2) == idx, "hole cards of " + to_string(idx));
+        check(popcount(hand) == 2 && get_hole_index(hand) == idx, "hole hand of " + to_string(idx));
+        check(hand == ((1ULL << get_bit_from_card(c1)) | (1ULL << get_bit_from_card(c2))), "hole bits of " + to_string(idx));
+    }
+}
+
+void check_boards() {
+    for (int k = 1; k <= 5; k++) {
+        cout << "Checking " << k << "-card boards..." << endl;
+        for (uint32_t idx = 0; idx < BOARD_SIZES[k]; idx++) {
+            uint64_t board = get_board_hand(idx, k);
+            check(popcount(board) == k && get_board_index(board) == idx, to_string(k) + "-card board " + to_string(idx));
+        }
+    }
+}
+
+// every preflop/flop hand: indices are in range, round-trip, and every class is hit
+void check_isomorphic_exhaustive(int street) {
+    cout << "Checking all hands for street " << street << "..." << endl;
+    uint64_t size = get_isomorphic_size(street);
+    check(size == ISOMORPHIC_SIZES[street], "size of street " + to_string(street));
+    vector<bool> hit(size, false);
+    for (uint32_t hole = 0; hole < 1326; hole++) {
+        uint64_t rounds[4] = {get_hole_hand(hole), 0, 0, 0};
+        for (uint32_t flop = 0; flop < (street ? BOARD_SIZES[3] : 1); flop++) {
+            rounds[1] = street ? get_board_hand(flop, 3) : 0;
+            if (rounds[0] & rounds[1]) continue;
+            uint64_t idx = get_isomorphic_index(rounds, street);
+            if (idx >= size) {
+                check(false, "index out of range on street " + to_string(street));
+                continue;
+            }
+            hit[idx] = true;
+            uint64_t canonical[4];
+            get_isomorphic_hand(idx, street, canonical);
+            check(get_isomorphic_index(canonical, street) == idx, "round trip of " + to_string(idx));
+        }
+    }
+    uint64_t count = 0;
+    for (bool h : hit) count += h;
+    check(count == size, "only " + to_string(count) + " classes hit on street " + to_string(street));
+}
+
+// random turn/river hands: invariant under suit permutations, and random indices round-trip
+void check_isomorphic_random(int street) {
+    cout << "Checking random hands for street " << street << "..." << endl;
+    uint64_t size = get_isomorphic_size(street);
+    check(size == ISOMORPHIC_SIZES[street], "size of street " + to_string(street));
+    mt19937_64 rng(street);
+    for (int it = 0; it < RANDOM_HANDS; it++) {
+        uint64_t rounds[4] = {0, 0, 0, 0};
+        uint64_t used = 0;
+        for (int r = 0; r <= street; r++) {
+            for (int dealt = 0; dealt < CARDS_PER_ROUND[r];) {
+                uint64_t bit = 1ULL << get_bit_from_card(rng() % 52);
+                if (used & bit) continue;
+                used |= bit;
+                rounds[r] |= bit;
+                dealt++;
+            }
+        }
+        uint64_t idx = get_isomorphic_index(rounds, street);
+        check(idx < size, "index out of range on street " + to_string(street));
+
+        int suits[4] = {0, 1, 2, 3};
+        shuffle(suits, suits + 4, rng);
+        uint64_t permuted[4];
+        for (int r = 0; r < 4; r++) {
+            permuted[r] = permute_suits(rounds[r], suits);
+        }
+        check(get_isomorphic_index(permuted, street) == idx, "suit permutation of " + to_string(idx));
+
+        uint64_t random_idx = rng() % size;
+        uint64_t canonical[4];
+        get_isomorphic_hand(random_idx, street, canonical);
+        uint64_t all = 0;
+        int count = 0;
+        for (int r = 0; r <= street; r++) {
+            check(popcount(canonical[r]) == CARDS_PER_ROUND[r], "cards per round of " + to_string(random_idx));
+            all |= canonical[r];
+            count += popcount(canonical[r]);
+        }
+        check(popcount(all) == count, "repeated card in " + to_string(random_idx));
+        check(get_isomorphic_index(canonical, street) == random_idx, "round trip of " + to_string(random_idx));
+    }
+}
+
+// rounds with the wrong number of cards, a repeated card or a bit outside the ranks are rejected
+void check_isomorphic_invalid() {
+    cout << "Checking invalid hands..." << endl;
+    uint64_t as = 1ULL << get_bit_from_card(51), ah = 1ULL << get_bit_from_card(50);
+    uint64_t kd = 1ULL << get_bit_from_card(45), qc = 1ULL << get_bit_from_card(40);
+    uint64_t jc = 1ULL << get_bit_from_card(36), deuce = 1ULL << get_bit_from_card(0);
+    struct { int street; uint64_t rounds[4]; string name; } invalid[] = {
+        {PREFLOP, {as, 0, 0, 0}, "one hole card"},
+        {PREFLOP, {as | ah | kd, 0, 0, 0}, "three hole cards"},
+        {PREFLOP, {as | (1ULL << 13), 0, 0, 0}, "a bit past the ace"},
+        {FLOP, {as | ah, kd | qc, 0, 0}, "a two-card flop"},
+        {FLOP, {as | ah, as | kd | qc, 0, 0}, "a flop repeating a hole card"},
+        {FLOP, {as | ah, kd | qc | (1ULL << 63), 0, 0}, "a flop with an unused bit"},
+        {RIVER, {as | ah, kd | qc | jc, deuce, deuce}, "a river repeating the turn"},
+    };
+    for (auto &hand : invalid) {
+        check(get_isomorphic_index(hand.rounds, hand.street) == INVALID_INDEX, hand.name + " was not rejected");
+    }
+    // later rounds than the street are never looked at
+    uint64_t turn[4] = {as | ah, kd | qc | jc, deuce, deuce};
+    check(get_isomorphic_index(turn, TURN) < get_isomorphic_size(TURN), "turn with a bad river");
+}
+
+int main() {
+    check_hole();
+    check_boards();
+    check_isomorphic_exhaustive(PREFLOP);
+    check_isomorphic_exhaustive(FLOP);
+    check_isomorphic_random(TURN);
+    check_isomorphic_random(RIVER);
+    check_isomorphic_invalid();
+
+    if (errors) {
+        cout << errors << " errors." << endl;
+        return 1;
+    }
+    cout << "All checks passed." << endl;
+    return 0;
+}
@@ -0,0 +1,285 @@
+#include "range.hpp"
+#include "cards.hpp"
+#include "cards_dev.hpp"
+#include "indexing.hpp"
+#include <bit>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace std;
+
+const uint32_t COMBO_WINS_HEADER[3] = {COMBO_WINS_MAGIC, COMBO_WINS_VERSION, NUM_COMBOS};
+
+// wins[a * NUM_COMBOS + b] is the number of boards where combo a beats combo b,
+// read from the per-matchup text files written by main.cpp
+// conflicting matchups (sharing a card) are left at zero
+vector<uint32_t> load_combo_wins(string results_dir) {
+  vector<uint32_t> wins((size_t) NUM_COMBOS * NUM_COMBOS, 0);
+  vector<string> names(NUM_COMBOS);
+  for (int a = 0; a < NUM_COMBOS; a++) {
+    names[a] = get_hand_string(get_hole_hand(a));
+  }
+
+  for (int a = 0; a < NUM_COMBOS; a++) {
+    uint64_t hand_a = get_hole_hand(a);
+    for (int b = 0; b < NUM_COMBOS; b++) {
+      if (hand_a & get_hole_hand(b)) {
+        continue;
+      }
+      string path = results_dir + "/" + names[a] + "/" + names[b] + ".txt";
+      ifstream file(path);
+      string line;
+      // first line is the header, second line is "Win:  xx.xxxx% (wins/total)"
+      getline(file, line);
+      getline(file, line);
+      size_t open = line.find('(');
+      size_t slash = line.find('/');
+      uint32_t count = 0;
+      from_chars_result parsed = {nullptr, errc::invalid_argument};
+      if (open != string::npos && slash != string::npos && open < slash) {
+        parsed = from_chars(line.data() + open + 1, line.data() + slash, count);
+      }
+      if (!file || parsed.ec != errc() || parsed.ptr != line.data() + slash) {
+        cout << "[!] Error: cannot read " << path << endl;
+        return {};
+      }
+      wins[(size_t) a * NUM_COMBOS + b] = count;
+    }
+  }
+  return wins;
+}
+
+// cache layout: COMBO_WINS_HEADER, then the NUM_COMBOS x NUM_COMBOS table
+bool write_combo_wins(string path, const vector<uint32_t> &wins) {
+  ofstream file(path, ios::binary);
+  file.write((const char *) COMBO_WINS_HEADER, sizeof(COMBO_WINS_HEADER));
+  file.write((const char *) wins.data(), wins.size() * sizeof(uint32_t));
+  file.close();
+  return (bool) file;
+}
+
+// returns an empty vector unless the file is exactly a cache of the current layout
+vector<uint32_t> read_combo_wins(string path) {
+  vector<uint32_t> wins((size_t) NUM_COMBOS * NUM_COMBOS);
+  error_code err;
+  uintmax_t size = fs::file_size(path, err);
+  if (err || size != sizeof(COMBO_WINS_HEADER) + wins.size() * sizeof(uint32_t)) {
+    cout << "[!] Error: " << path << " is truncated or not a combo cache." << endl;
+    return {};
+  }
+
+  uint32_t header[3];
+  ifstream file(path, ios::binary);
+  file.read((char *) header, sizeof(header));
+  if (!file || header[0] != COMBO_WINS_HEADER[0] || header[1] != COMBO_WINS_HEADER[1] ||
+      header[2] != COMBO_WINS_HEADER[2]) {
+    cout << "[!] Error: " << path << " was written for a different combo layout." << endl;
+    return {};
+  }
+  file.read((char *) wins.data(), wins.size() * sizeof(uint32_t));
+  if (!file) {
+    cout << "[!] Error: cannot read " << path << endl;
+    return {};
+  }
+  return wins;
+}
+
+// equity[a * NUM_COMBOS + b] = P(a wins) + P(tie) / 2 for combo a against combo b,
+// zero if they share a card so that card removal falls out of the products below
+vector<float> get_equity_matrix(const vector<uint32_t> &wins) {
+  vector<float> equity((size_t) NUM_COMBOS * NUM_COMBOS, 0.f);
+  for (int a = 0; a < NUM_COMBOS; a++) {
+    uint64_t hand_a = get_hole_hand(a);
+    for (int b = 0; b < NUM_COMBOS; b++) {
+      int64_t win = wins[(size_t) a * NUM_COMBOS + b];
+      int64_t loss = wins[(size_t) b * NUM_COMBOS + a];
+      // (win + tie / 2) / total, with tie = total - win - loss
+      float value = (float) (BOARDS_PER_MATCHUP + win - loss) / (2.f * BOARDS_PER_MATCHUP);
+      equity[(size_t) a * NUM_COMBOS + b] = (hand_a & get_hole_hand(b)) ? 0.f : value;
+    }
+  }
+  return equity;
+}
+
+// parse a comma-separated list of canonical hands ("AA", "AKs", "AKo", "AK")
+// and/or specific combos ("AsKh") into a set of combos
+// ranks are read case-insensitively and in either order, like query_matchup.py,
+// and every token that matches no combo is appended to rejected
+range_bits get_range_bits(string range_str, vector<string> &rejected) {
+  range_bits range;
+  stringstream stream(range_str);
+  string token;
+  while (getline(stream, token, ',')) {
+    // strip whitespace
+    string hand = "";
+    for (char c : token) {
+      if (!isspace(c)) hand += c;
+    }
+    if (hand.empty()) continue;
+
+    if (hand.length() == 4) {
+      // ranks upper case, suits lower case
+      string combo = {(char) toupper(hand[0]), (char) tolower(hand[1]), (char) toupper(hand[2]), (char) tolower(hand[3])};
+      bool valid = RANKS.find(combo[0]) != string::npos && SUITS.find(combo[1]) != string::npos &&
+                   RANKS.find(combo[2]) != string::npos && SUITS.find(combo[3]) != string::npos;
+      // get_hand_num only accepts valid cards, and a repeated card is not a combo
+      if (!valid || popcount(get_hand_num(combo)) != 2) {
+        rejected.push_back(token);
+        continue;
+      }
+      range[get_hole_index(get_hand_num(combo))] = true;
+      continue;
+    }
+
+    // canonical hands go to their get_canonical_hand index once, high rank first
+    size_t high = (hand.length() >= 2) ? RANKS.find(toupper(hand[0])) : string::npos;
+    size_t low = (hand.length() >= 2) ? RANKS.find(toupper(hand[1])) : string::npos;
+    char suffix = (hand.length() == 3) ? tolower(hand[2]) : ' ';
+    if (high > low) {
+      swap(high, low);
+    }
+    // "AK" stands for both "AKs" and "AKo", pairs take no suffix
+    bool suited = (high != low) && (suffix == 's' || suffix == ' ');
+    bool off_suit = (high != low) && (suffix == 'o' || suffix == ' ');
+    bool pair = (high == low) && (suffix == ' ');
+    if (low == string::npos || hand.length() > 3 || !(suited || off_suit || pair)) {
+      rejected.push_back(token);
+      continue;
+    }
+    int suited_idx = (suited || pair) ? high * 13 + low : -1;
+    int off_suit_idx = (off_suit || pair) ? low * 13 + high : -1;
+
+    for (int idx = 0; idx < NUM_COMBOS; idx++) {
+      int canonical = get_canonical_hand(get_hole_hand(idx));
+      range[idx] = range[idx] | (canonical == suited_idx) | (canonical == off_suit_idx);
+    }
+  }
+  return range;
+}
+
+range_weights get_range_weights(const range_bits &range) {
+  range_weights weights(NUM_COMBOS);
+  for (int idx = 0; idx < NUM_COMBOS; idx++) {
+    weights[idx] = range[idx];
+  }
+  return weights;
+}
+
+// for one villain, the total weight of the villain combos not blocked by each hero combo:
+// everything, minus combos sharing either card, plus the hero combo itself (subtracted twice)
+void get_unblocked_weights(const range_weights &villain, float *unblocked, int stride) {
+  float card_sum[52] = {0};
+  float total = 0;
+  for (int idx = 0; idx < NUM_COMBOS; idx++) {
+    int c1, c2;
+    get_hole_cards(idx, c1, c2);
+    card_sum[c1] += villain[idx];
+    card_sum[c2] += villain[idx];
+    total += villain[idx];
+  }
+  for (int idx = 0; idx < NUM_COMBOS; idx++) {
+    int c1, c2;
+    get_hole_cards(idx, c1, c2);
+    unblocked[idx * stride] = total - card_sum[c1] - card_sum[c2] + villain[idx];
+  }
+}
+
+// a single matchup only touches the rows and columns of combos actually in the ranges,
+// which for typical preflop ranges is a few thousand terms instead of the whole matrix
+// a matchup where no combos can meet returns 0
+double get_range_equity(const vector<float> &equity, const range_weights &hero, const range_weights &villain) {
+  vector<int> villain_combos;
+  vector<uint64_t> villain_hands;
+  for (int b = 0; b < NUM_COMBOS; b++) {
+    if (villain[b] != 0) {
+      villain_combos.push_back(b);
+      villain_hands.push_back(get_hole_hand(b));
+    }
+  }
+
+  double numerator = 0;
+  double denominator = 0;
+  for (int a = 0; a < NUM_COMBOS; a++) {
+    if (hero[a] == 0) continue;
+    const float *row = &equity[(size_t) a * NUM_COMBOS];
+    uint64_t hand_a = get_hole_hand(a);
+    double product = 0;
+    double unblocked = 0;
+    for (size_t i = 0; i < villain_combos.size(); i++) {
+      float weight = villain[villain_combos[i]];
+      // the equity of a conflicting matchup is already zero
+      product += weight * row[villain_combos[i]];
+      unblocked += (hand_a & villain_hands[i]) ? 0.f : weight;
+    }
+    numerator += hero[a] * product;
+    denominator += hero[a] * unblocked;
+  }
+  return (denominator > 0) ? numerator / denominator : 0.;
+}
+
+// equity of every hero range against every villain range, result[h * villains.size() + v]
+// the matrix is streamed once per RANGE_BLOCK_SIZE villains, and the fixed-width
+// inner loop over the block is what the compiler turns into SIMD
+// a matchup where no combos can meet returns 0
+vector<double> get_range_equity_batch(const vector<float> &equity,
+                                      const vector<range_weights> &heroes,
+                                      const vector<range_weights> &villains) {
+  int num_heroes = heroes.size();
+  int num_villains = villains.size();
+  vector<double> result((size_t) num_heroes * num_villains, 0.);
+
+  // villain weights and products interleaved as [combo][block slot]
+  vector<float> block((size_t) NUM_COMBOS * RANGE_BLOCK_SIZE);
+  vector<float> products((size_t) NUM_COMBOS * RANGE_BLOCK_SIZE);
+  vector<float> unblocked((size_t) NUM_COMBOS * RANGE_BLOCK_SIZE);
+
+  for (int start = 0; start < num_villains; start += RANGE_BLOCK_SIZE) {
+    int count = min(RANGE_BLOCK_SIZE, num_villains - start);
+    fill(block.begin(), block.end(), 0.f);
+    fill(unblocked.begin(), unblocked.end(), 0.f);
+    for (int k = 0; k < count; k++) {
+      for (int b = 0; b < NUM_COMBOS; b++) {
+        block[b * RANGE_BLOCK_SIZE + k] = villains[start + k][b];
+      }
+      get_unblocked_weights(villains[start + k], &unblocked[k], RANGE_BLOCK_SIZE);
+    }
+
+    // products[a][k] = sum_b equity[a][b] * villain_k[b]
+    for (int a = 0; a < NUM_COMBOS; a++) {
+      const float *row = &equity[(size_t) a * NUM_COMBOS];
+      float acc[RANGE_BLOCK_SIZE] = {0};
+      for (int b = 0; b < NUM_COMBOS; b++) {
+        const float *weights = &block[b * RANGE_BLOCK_SIZE];
+        for (int k = 0; k < RANGE_BLOCK_SIZE; k++) {
+          acc[k] += row[b] * weights[k];
+        }
+      }
+      for (int k = 0; k < RANGE_BLOCK_SIZE; k++) {
+        products[a * RANGE_BLOCK_SIZE + k] = acc[k];
+      }
+    }
+
+    // equity = sum_a hero[a] * products[a] / sum_a hero[a] * unblocked[a]
+    for (int h = 0; h < num_heroes; h++) {
+      double numerator[RANGE_BLOCK_SIZE] = {0};
+      double denominator[RANGE_BLOCK_SIZE] = {0};
+      for (int a = 0; a < NUM_COMBOS; a++) {
+        float weight = heroes[h][a];
+        for (int k = 0; k < RANGE_BLOCK_SIZE; k++) {
+          numerator[k] += weight * products[a * RANGE_BLOCK_SIZE + k];
+          denominator[k] += weight * unblocked[a * RANGE_BLOCK_SIZE + k];
+        }
+      }
+      for (int k = 0; k < count; k++) {
+        result[(size_t) h * num_villains + start + k] = (denominator[k] > 0) ? numerator[k] / denominator[k] : 0.;
+      }
+    }
+  }
+  return result;
+}
@@ -0,0 +1,37 @@
+#ifndef RANGE_HPP
+#define RANGE_HPP
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// number of distinct 2-card combos, C(52, 2)
+const int NUM_COMBOS = 1326;
+// number of boards for every non-conflicting heads-up matchup, C(48, 5)
+const int BOARDS_PER_MATCHUP = 1712304;
+// how many villain ranges share one pass over the equity matrix
+const int RANGE_BLOCK_SIZE = 8;
+
+// a range is either a set of combos or a weight per combo, both indexed by get_hole_index
+typedef std::bitset<NUM_COMBOS> range_bits;
+typedef std::vector<float> range_weights;
+
+// the binary cache starts with these, bump the version whenever the combo index layout changes
+const std::uint32_t COMBO_WINS_MAGIC = 0x57435150; // "PQCW"
+const std::uint32_t COMBO_WINS_VERSION = 1;
+
+std::vector<std::uint32_t> load_combo_wins(std::string results_dir);
+bool write_combo_wins(std::string path, const std::vector<std::uint32_t> &wins);
+std::vector<std::uint32_t> read_combo_wins(std::string path);
+std::vector<float> get_equity_matrix(const std::vector<std::uint32_t> &wins);
+
+range_bits get_range_bits(std::string range_str, std::vector<std::string> &rejected);
+range_weights get_range_weights(const range_bits &range);
+
+double get_range_equity(const std::vector<float> &equity, const range_weights &hero, const range_weights &villain);
+std::vector<double> get_range_equity_batch(const std::vector<float> &equity,
+                                           const std::vector<range_weights> &heroes,
+                                           const std::vector<range_weights> &villains);
+
+#endif // RANGE_HPP
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <string>
+
+#include "cards.hpp"
+#include "cards_dev.hpp"
+#include "indexing.hpp"
+#include "range.hpp"
+
+using namespace std;
+
+// checks of the range engine on a synthetic win table, prints every failure and exits nonzero
+// the table is random, so these check the arithmetic and the card removal, not poker
+const double TOLERANCE = 1e-5;
+const int NUM_HEROES = 5;
+// not a multiple of RANGE_BLOCK_SIZE, so the last block is partial
+const int NUM_VILLAINS = 2 * RANGE_BLOCK_SIZE + 3;
+
+int errors = 0;
+
+void check(bool ok, string message) {
+    if (!ok && errors++ < 10) {
+        cout << "[!] Error: " << message << endl;
+    }
+}
+
+// wins[a][b] + wins[b][a] <= BOARDS_PER_MATCHUP for every non-conflicting pair
+vector<uint32_t> get_random_wins(mt19937 &rng) {
+    vector<uint32_t> wins((size_t) NUM_COMBOS * NUM_COMBOS, 0);
+    for (int a = 0; a < NUM_COMBOS; a++) {
+        for (int b = a + 1; b < NUM_COMBOS; b++) {
+            if (get_hole_hand(a) & get_hole_hand(b)) continue;
+            uint32_t win = rng() % BOARDS_PER_MATCHUP;
+            wins[(size_t) a * NUM_COMBOS + b] = win;
+            wins[(size_t) b * NUM_COMBOS + a] = rng() % (BOARDS_PER_MATCHUP - win);
+        }
+    }
+    return wins;
+}
+
+// about one combo in `sparsity` gets a random weight in (0, 1]
+range_weights get_random_range(mt19937 &rng, int sparsity) {
+    range_weights range(NUM_COMBOS, 0.f);
+    uniform_real_distribution<float> weight(0.01f, 1.f);
+    for (int idx = 0; idx < NUM_COMBOS; idx++) {
+        range[idx] = (rng() % sparsity == 0) ? weight(rng) : 0.f;
+    }
+    return range;
+}
+
+// straight from the definition: every pair of combos that can meet, weighted
+double get_reference_equity(const vector<float> &equity, const range_weights &hero, const range_weights &villain) {
+    double numerator = 0, denominator = 0;
+    for (int a = 0; a < NUM_COMBOS; a++) {
+        for (int b = 0; b < NUM_COMBOS; b++) {
+            if (get_hole_hand(a) & get_hole_hand(b)) continue;
+            numerator += (double) hero[a] * villain[b] * equity[(size_t) a * NUM_COMBOS + b];
+            denominator += (double) hero[a] * villain[b];
+        }
+    }
+    return (denominator > 0) ? numerator / denominator : 0.;
+}
+
+range_weights get_range(string range_str) {
+    vector<string> rejected;
+    range_weights range = get_range_weights(get_range_bits(range_str, rejected));
+    check(rejected.empty(), "rejected tokens in '" + range_str + "'");
+    return range;
+}
+
+void check_parsing() {
+    cout << "Checking range parsing..." << endl;
+    // every canonical hand by name picks exactly its combos
+    for (int canonical = 0; canonical < 169; canonical++) {
+        string name = get_canonical_from_idx(canonical);
+        vector<string> rejected;
+        range_bits range = get_range_bits(name, rejected);
+        size_t expected = (name.length() == 2) ? 6 : (name[2] == 's' ? 4 : 12);
+        check(rejected.empty() && range.count() == expected, "combos of " + name);
+        for (int idx = 0; idx < NUM_COMBOS; idx++) {
+            check(!range[idx] || get_canonical_hand(get_hole_hand(idx)) == canonical, "wrong combo in " + name);
+        }
+    }
+    for (string bad : {"AsKx", "AsAs", "QQ+", "AAs", "XYo", "A", "AKx"}) {
+        vector<string> rejected;
+        get_range_bits(bad, rejected);
+        check(rejected.size() == 1, "'" + bad + "' was not rejected");
+    }
+}
+
+void check_equities(const vector<float> &equity, mt19937 &rng) {
+    cout << "Checking single and batch equities..." << endl;
+    vector<range_weights> heroes, villains;
+    for (int h = 0; h < NUM_HEROES; h++) {
+        heroes.push_back(get_random_range(rng, 2 + 5 * h));
+    }
+    for (int v = 0; v < NUM_VILLAINS; v++) {
+        villains.push_back(get_random_range(rng, 2 + v));
+    }
+    // a villain with no combos at all gives 0
+    villains.push_back(range_weights(NUM_COMBOS, 0.f));
+
+    vector<double> batch = get_range_equity_batch(equity, heroes, villains);
+    check(batch.size() == heroes.size() * villains.size(), "batch result size");
+    for (size_t h = 0; h < heroes.size(); h++) {
+        for (size_t v = 0; v < villains.size(); v++) {
+            double reference = get_reference_equity(equity, heroes[h], villains[v]);
+            double single = get_range_equity(equity, heroes[h], villains[v]);
+            string pair = to_string(h) + " vs " + to_string(v);
+            check(fabs(single - reference) < TOLERANCE, "single equity of " + pair);
+            check(fabs(batch[h * villains.size() + v] - reference) < TOLERANCE, "batch equity of " + pair);
+        }
+    }
+}
+
+void check_card_removal(const vector<float> &equity) {
+    cout << "Checking card removal..." << endl;
+    // only AdAc of AA can meet AsAh
+    range_weights aces = get_range("AA");
+    range_weights villain = get_range("AsAh");
+    double expected = equity[(size_t) get_hole_index(get_hand_num("AdAc")) * NUM_COMBOS + get_hole_index(get_hand_num("AsAh"))];
+    check(fabs(get_range_equity(equity, aces, villain) - expected) < TOLERANCE, "AA vs AsAh");
+    check(fabs(get_range_equity_batch(equity, {aces}, {villain})[0] - expected) < TOLERANCE, "batch AA vs AsAh");
+
+    // nothing can meet: every combo shares a card
+    range_weights blocked = get_range("AsKs");
+    range_weights blockers = get_range("AsKh, AhKs");
+    check(get_range_equity(equity, blocked, blockers) == 0., "AsKs vs AsKh, AhKs");
+    check(get_range_equity_batch(equity, {blocked}, {blockers})[0] == 0., "batch AsKs vs AsKh, AhKs");
+
+    // a combo against itself in both ranges is removed, the rest count
+    range_weights kings = get_range("KK");
+    check(fabs(get_range_equity(equity, kings, kings) - get_reference_equity(equity, kings, kings)) < TOLERANCE, "KK vs KK");
+}
+
+int main() {
+    mt19937 rng(1);
+    vector<float> equity = get_equity_matrix(get_random_wins(rng));
+
+    check_parsing();
+    check_equities(equity, rng);
+    check_card_removal(equity);
+
+    if (errors) {
+        cout << errors << " errors." << endl;
+        return 1;
+    }
+    cout << "All checks passed." << endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include <filesystem>
+#include <string>
+
+#include "range.hpp"
+
+namespace fs = std::filesystem;
+using namespace std;
+
+// the per-matchup text files are slow to parse, so keep a binary copy of the counts
+const string RESULTS_DIR = "results";
+const string COMBO_WINS_PATH = "results/combo_wins.bin";
+
+// parse one range, or print the tokens that are not hands and return an empty range
+range_bits get_checked_range(string range_str) {
+    vector<string> rejected;
+    range_bits range = get_range_bits(range_str, rejected);
+    if (!rejected.empty()) {
+        cout << "Not a valid hand:";
+        for (string token : rejected) cout << " '" << token << "'";
+        cout << endl;
+        return {};
+    }
+    return range;
+}
+
+// batch mode: one hero range against every villain range on stdin, one per line,
+// all evaluated in a single get_range_equity_batch call
+int run_batch(const vector<float>& equity, string hero_str) {
+    range_bits hero = get_checked_range(hero_str);
+    if (hero.none()) {
+        cout << "[!] Error: not a valid hero range." << endl;
+        return 1;
+    }
+
+    vector<string> villain_strs;
+    vector<range_weights> villains;
+    string line;
+    while (getline(cin, line)) {
+        range_bits villain = get_checked_range(line);
+        if (villain.none()) {
+            cout << "[!] Error: skipping villain range '" << line << "'" << endl;
+            continue;
+        }
+        villain_strs.push_back(line);
+        villains.push_back(get_range_weights(villain));
+    }
+
+    vector<double> equities = get_range_equity_batch(equity, {get_range_weights(hero)}, villains);
+    for (size_t v = 0; v < villains.size(); v++) {
+        printf("%7.4f%%\t%s\n", 100. * equities[v], villain_strs[v].c_str());
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    vector<uint32_t> wins;
+    if (fs::exists(COMBO_WINS_PATH)) {
+        wins = read_combo_wins(COMBO_WINS_PATH);
+    }
+    if (wins.empty()) {
+        cout << "Loading matchups from " << RESULTS_DIR << "..." << endl;
+        wins = load_combo_wins(RESULTS_DIR);
+        if (wins.empty()) {
+            cout << "[!] Error: run main first to generate the heads-up results." << endl;
+            return 1;
+        }
+        if (!write_combo_wins(COMBO_WINS_PATH, wins)) {
+            cout << "[!] Error: cannot write " << COMBO_WINS_PATH << ", it will be rebuilt next time." << endl;
+        }
+    }
+    vector<float> equity = get_equity_matrix(wins);
+    cout << "Loaded database." << endl;
+
+    if (argc > 1) {
+        return run_batch(equity, argv[1]);
+    }
+
+    while (true) {
+        string hero_str, villain_str;
+        cout << endl << "Hero's range: ";
+        if (!getline(cin, hero_str)) break;
+        cout << "Villain's range: ";
+        if (!getline(cin, villain_str)) break;
+
+        range_bits hero = get_checked_range(hero_str);
+        range_bits villain = get_checked_range(villain_str);
+        if (hero.none() || villain.none()) {
+            cout << "Not a valid range!" << endl;
+            continue;
+        }
+
+        double hero_equity = get_range_equity(equity, get_range_weights(hero), get_range_weights(villain));
+        printf("Hero (%zu combos) vs Villain (%zu combos)\n", hero.count(), villain.count());
+        printf("Equity: %7.4f%%\n", 100. * hero_equity);
+    }
+
+    return 0;
+}
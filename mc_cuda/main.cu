@@ -5,6 +5,7 @@
 #include <fstream>
 #include <ctime>
 #include <chrono>
+#include <cmath>
 
 #include <cuda_runtime.h>
 #include <curand_kernel.h>
@@ -25,8 +26,24 @@ using namespace std;
 // tune this so that it takes however long you want to run
 #define SIMS_PER_THREAD 10000
 
+// convergence parameters
+// stop once every (hand, player count) equity is within this of the truth at the given confidence
+// set to 0 to run forever
+#define TARGET_HALF_WIDTH 0.0001
+// z-score of the confidence interval, 1.96 for 95%
+#define CONFIDENCE_Z 1.96
+// don't trust the variance estimate of a cell before it has this many samples
+#define MIN_SAMPLES_PER_CELL 10000
+// only rewrite a file when one of its equities moved by more than this since the last write
+#define WRITE_DELTA 0.0001
+
 // 169 hands x (sum of player counts)
 const int TOTAL_VECTOR_SIZE = 169 * (MIN_NUM_PLAYERS + MAX_NUM_PLAYERS + 2) * (MAX_NUM_PLAYERS - MIN_NUM_PLAYERS + 1) / 2;
+// one cell per (player count, hand)
+const int NUM_PLAYER_COUNTS = MAX_NUM_PLAYERS - MIN_NUM_PLAYERS + 1;
+const int NUM_CELLS = 169 * NUM_PLAYER_COUNTS;
+// every player's hole cards and the board, i.e. everything shuffled per simulation
+const int CARDS_DEALT = 2 * MAX_NUM_PLAYERS + 5;
 
 #define CHECK_CUDA(call) { \
     cudaError_t err = call; \
@@ -56,15 +73,14 @@ __global__ void mc_kernel(curandState *state, uint64_t *results, int num_sims) {
     int cards[52];
     uint64_t hands[MAX_NUM_PLAYERS];
     uint32_t values[MAX_NUM_PLAYERS];
-    uint32_t tracker_max[MAX_NUM_PLAYERS][MAX_NUM_PLAYERS];
-    int tracker_count[MAX_NUM_PLAYERS][MAX_NUM_PLAYERS];
+    uint32_t hand_canons[MAX_NUM_PLAYERS];
 
     for (int i = 0; i < 52; ++i) cards[i] = i;
 
     for (int sim = 0; sim < num_sims; ++sim) {
-        // Fisher-Yates shuffle
-        for (int i = 51; i > 0; --i) {
-            int j = curand(&localState) % (i + 1);
+        // partial Fisher-Yates, only as far as we deal
+        for (int i = 0; i < CARDS_DEALT; ++i) {
+            int j = i + curand(&localState) % (52 - i);
             int temp = cards[i];
             cards[i] = cards[j];
             cards[j] = temp;
@@ -84,59 +100,72 @@ __global__ void mc_kernel(curandState *state, uint64_t *results, int num_sims) {
 
         for (int player_idx = 0; player_idx < MAX_NUM_PLAYERS; player_idx++) {
             values[player_idx] = get_hand_value(hands[player_idx] | board);
+            hand_canons[player_idx] = get_canonical_hand(hands[player_idx]);
         }
 
-        // Reset trackers
-        memset(tracker_max, 0, sizeof(tracker_max));
-        memset(tracker_count, 0, sizeof(tracker_count));
-
+        // every seat is recorded: a game of n players for a seat is that seat against
+        // the next n - 1 around the table, so track the running max and how many share it
         for (int player_idx = 0; player_idx < MAX_NUM_PLAYERS; player_idx++) {
-            tracker_max[player_idx][player_idx] = values[player_idx];
-            tracker_count[player_idx][player_idx] = 1;
-
-            for (int p_idx_shift = 1; p_idx_shift < MAX_NUM_PLAYERS; p_idx_shift++) {
-                int player_idx_to = (player_idx + p_idx_shift) % MAX_NUM_PLAYERS;
-                int prev_idx = (player_idx_to + MAX_NUM_PLAYERS - 1) % MAX_NUM_PLAYERS;
-                
-                uint32_t current_val = values[player_idx_to];
-                uint32_t prev_max = tracker_max[player_idx][prev_idx];
-                
-                tracker_max[player_idx][player_idx_to] = (prev_max > current_val) ? prev_max : current_val;
-                
-                tracker_count[player_idx][player_idx_to] = (
-                    current_val >= prev_max
-                ) + tracker_count[player_idx][prev_idx] * (
-                    current_val <= prev_max
-                );
-            }
-        }
+            uint32_t max_value = values[player_idx];
+            int tie_count = 1;
+            int starting_idx = 0;
+            for (int player_count = 2; player_count <= MAX_NUM_PLAYERS; player_count++) {
+                uint32_t current_val = values[(player_idx + player_count - 1) % MAX_NUM_PLAYERS];
+                tie_count = (current_val >= max_value) + tie_count * (current_val <= max_value);
+                max_value = (max_value > current_val) ? max_value : current_val;
+                if (player_count < MIN_NUM_PLAYERS) continue;
+
+                uint32_t offset = (values[player_idx] == max_value) * (tie_count - 1) + \
+                    (values[player_idx] != max_value) * player_count;
 
-        // update results
-        int starting_idx = 0;
-        for (int player_count = MIN_NUM_PLAYERS; player_count <= MAX_NUM_PLAYERS; player_count++) {
-            for (int player_idx = 0; player_idx < MAX_NUM_PLAYERS; player_idx++) {
-                uint32_t hand_canon = get_canonical_hand(hands[player_idx]);
-                int idx_to_check = (player_idx + player_count - 1) % MAX_NUM_PLAYERS;
-                uint32_t max_result = tracker_max[player_idx][idx_to_check];
-                int tie_count = tracker_count[player_idx][idx_to_check];
-                
-                uint32_t offset = (values[player_idx] == max_result) * (tie_count - 1) + \
-                    (values[player_idx] != max_result) * player_count;
-                
                 // record win/loss/tie
-                size_t update_idx = starting_idx + hand_canon * (player_count + 1) + offset;
+                size_t update_idx = starting_idx + hand_canons[player_idx] * (player_count + 1) + offset;
                 atomicAdd((unsigned long long*) &results[update_idx], 1ULL);
+                starting_idx += 169 * (player_count + 1);
             }
-            starting_idx += 169 * (player_count + 1);
         }
     }
     state[id] = localState;
 }
 
-void write_out(const vector<uint64_t>& results) {
+// equity of every cell and the half-width of its confidence interval, indexed by
+// (player_count - MIN_NUM_PLAYERS) * 169 + hand
+// a sample's equity is 1 for a win, 1/k for a k-way tie and 0 for a loss,
+// so the counts already hold everything needed for its mean and variance
+void get_cell_stats(const vector<uint64_t>& results, vector<uint64_t>& samples,
+                    vector<double>& means, vector<double>& half_widths) {
+    int current = 0;
+    for (int player_count = MIN_NUM_PLAYERS; player_count <= MAX_NUM_PLAYERS; player_count++) {
+        for (int i = 0; i < 169; i++) {
+            uint64_t n = 0;
+            double sum = 0, sum_sq = 0;
+            for (int j = 0; j <= player_count; j++) {
+                uint64_t count = results[current++];
+                // j is the number of other players tied with us, j == player_count is a loss
+                double share = (j < player_count) ? 1. / (j + 1) : 0.;
+                n += count;
+                sum += count * share;
+                sum_sq += count * share * share;
+            }
+            int cell = (player_count - MIN_NUM_PLAYERS) * 169 + i;
+            double mean = n ? sum / n : 0.;
+            double variance = n > 1 ? (sum_sq - n * mean * mean) / (n - 1) : 0.;
+            samples[cell] = n;
+            means[cell] = mean;
+            half_widths[cell] = n > 1 ? CONFIDENCE_Z * sqrt(max(variance, 0.) / n) : INFINITY;
+        }
+    }
+}
+
+// only the player counts flagged in to_write are rewritten
+void write_out(const vector<uint64_t>& results, const vector<bool>& to_write) {
     int current = 0;
     // write out results
     for (int player_count = MIN_NUM_PLAYERS; player_count <= MAX_NUM_PLAYERS; player_count++) {
+        if (!to_write[player_count - MIN_NUM_PLAYERS]) {
+            current += 169 * (player_count + 1);
+            continue;
+        }
         ofstream file("results/" + to_string(player_count) + "p_mc.csv");
         for (int i = 0; i < 169; i++) {
             for (int j = 0; j <= player_count; j++) {
@@ -161,8 +190,15 @@ int main(int argc, char** argv) {
     CHECK_CUDA(cudaMalloc(&device_state, THREADS_PER_BLOCK * BLOCKS_PER_GRID * sizeof(curandState)));
     setup_kernel<<<BLOCKS_PER_GRID, THREADS_PER_BLOCK>>>(device_state, time(NULL));
     CHECK_CUDA(cudaGetLastError());
-    
+
     vector<uint64_t> host_results(TOTAL_VECTOR_SIZE);
+    vector<uint64_t> samples(NUM_CELLS, 0);
+    vector<double> means(NUM_CELLS), half_widths(NUM_CELLS, INFINITY);
+    // once converged a cell stays converged, even though it keeps getting samples
+    vector<bool> converged(NUM_CELLS, false);
+    // anything out of [0, 1] forces the first write
+    vector<double> written_means(NUM_CELLS, -1.);
+    fs::create_directories("results");
     cout << "Running simulation on GPU..." << endl;
 
     // std::chrono::high_resolution_clock::time_point start, end;
@@ -175,8 +211,38 @@ int main(int argc, char** argv) {
         // cout << "Time elapsed: " << (end - start).count() / 1e9 << "s" << endl;
 
         CHECK_CUDA(cudaMemcpy(host_results.data(), device_results, result_size, cudaMemcpyDeviceToHost));
-        write_out(host_results);
-   }
+        get_cell_stats(host_results, samples, means, half_widths);
+
+        int converged_cells = 0;
+        double max_half_width = 0;
+        for (int cell = 0; cell < NUM_CELLS; cell++) {
+            converged[cell] = converged[cell] || (TARGET_HALF_WIDTH > 0 &&
+                samples[cell] >= MIN_SAMPLES_PER_CELL && half_widths[cell] <= TARGET_HALF_WIDTH);
+            converged_cells += converged[cell];
+            // the worst cell still running that has an interval at all
+            if (!converged[cell] && samples[cell] > 1) {
+                max_half_width = max(max_half_width, half_widths[cell]);
+            }
+        }
+        bool done = converged_cells == NUM_CELLS;
+
+        // skip the disk entirely unless some estimate moved, and always write the final one
+        vector<bool> to_write(NUM_PLAYER_COUNTS, done);
+        for (int cell = 0; cell < NUM_CELLS; cell++) {
+            to_write[cell / 169] = to_write[cell / 169] || fabs(means[cell] - written_means[cell]) > WRITE_DELTA;
+        }
+        for (int cell = 0; cell < NUM_CELLS; cell++) {
+            written_means[cell] = to_write[cell / 169] ? means[cell] : written_means[cell];
+        }
+        write_out(host_results, to_write);
+
+        if (done) {
+            cout << "All " << NUM_CELLS << " cells converged." << endl;
+            break;
+        }
+        cout << "Converged " << converged_cells << "/" << NUM_CELLS << " cells, max half-width of the rest "
+             << 100. * max_half_width << "%" << endl;
+    }
     
     CHECK_CUDA(cudaFree(device_results));
     CHECK_CUDA(cudaFree(device_state));